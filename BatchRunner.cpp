@@ -0,0 +1,88 @@
+#include "BatchRunner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+BatchRunner::BatchRunner(std::shared_ptr<const GameConfig> config, const GameOptions& options, int worlds, int threads)
+    : m_config(config), m_options(options), m_worlds(worlds), m_threads(std::max(1, std::min(threads, worlds)))
+{
+    // Worlds never open a window, drive themselves and leave reporting to the runner.
+    // Gauges are process-wide, so concurrent worlds would just overwrite each other's score
+    m_options.headless = true;
+    m_options.autopilot = true;
+    m_options.report = false;
+    m_options.gauges = false;
+}
+
+void BatchRunner::runWorld(int world)
+{
+    auto start = std::chrono::steady_clock::now();
+    GameOptions options = m_options;
+    options.seed = m_options.seed + world;
+    Game game(m_config, options);
+    game.run();
+
+    WorldResult& result = m_results[world];
+    result.ran = true;
+    result.seed = game.getSeed();
+    result.score = game.getScore();
+    result.frames = game.getCurrentFrame();
+    result.peakEntities = game.getFrameStats().getPeakEntities();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BatchRunner::run()
+{
+    m_results.assign(m_worlds, WorldResult());
+    std::atomic<int> nextWorld{0};
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < m_threads; t++)
+    {
+        workers.emplace_back([this, &nextWorld]()
+        {
+            while(!Game::stopRequested())
+            {
+                int world = nextWorld++;
+                if(world >= m_worlds)
+                {
+                    break;
+                }
+                runWorld(world);
+            }
+        });
+    }
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BatchRunner::report(std::ostream& out) const
+{
+    int64_t totalFrames = 0;
+    int worldsRun = 0;
+    for(size_t world = 0; world < m_results.size(); world++)
+    {
+        const WorldResult& result = m_results[world];
+        if(!result.ran)
+        {
+            continue;
+        }
+        out << "World " << world << ": seed " << result.seed << " score " << result.score << " frames " << result.frames
+            << " peak entities " << result.peakEntities << " time " << result.seconds << "s\n";
+        totalFrames += result.frames;
+        worldsRun++;
+    }
+    out << "Worlds: " << worldsRun << " of " << m_worlds << " on " << m_threads << " threads\n";
+    out << "Total frames: " << totalFrames << " in " << m_seconds << "s\n";
+    if(m_seconds > 0.0)
+    {
+        out << "Ticks per second: " << totalFrames / m_seconds << " aggregate, "
+            << totalFrames / m_seconds / m_threads << " per thread" << std::endl;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <ostream>
+#include "Game.h"
+
+struct WorldResult {bool ran = false; uint64_t seed = 0; int64_t score = 0; int64_t frames = 0; size_t peakEntities = 0; double seconds = 0.0;}; //Outcome of one headless match
+
+// Runs many independent headless autopilot matches in one process. Every world shares the
+// same parsed GameConfig and is otherwise self-contained, so worlds are handed out one per
+// task to a fixed set of worker threads with nothing shared between them but a counter.
+// World i is seeded with the batch seed plus i, so results do not depend on the thread count.
+// Once a stop is requested no new worlds are started and only the worlds that ran are reported.
+class BatchRunner
+{
+    private:
+        std::shared_ptr<const GameConfig> m_config;
+        GameOptions m_options;
+        int m_worlds;
+        int m_threads;
+        std::vector<WorldResult> m_results;
+        double m_seconds = 0.0;
+
+        void runWorld(int world);
+    public:
+        BatchRunner(std::shared_ptr<const GameConfig> config, const GameOptions& options, int worlds, int threads);
+        void run();
+        void report(std::ostream& out) const;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Vec2.h"
+#include <cstdint>
 #include <SFML/Graphics.hpp>
 
 class CTransform 
@@ -48,10 +49,10 @@ class CScore
 class CLifeSpan
 {
     public:
-        int remaining = 0; //remaining lifespan in frames
+        int64_t deathFrame = 0; //absolute frame the entity expires on
         int total = 0; //total lifespan in frames
-        CLifeSpan(int l)
-            : remaining(l), total(l) {}
+        CLifeSpan(int l, int64_t currentFrame)
+            : deathFrame(currentFrame + l), total(l) {}
 };
 
 class CInput
@@ -63,6 +64,7 @@ class CInput
         bool right = false;
         bool shoot = false;
         bool special = false;
+        Vec2 aim = {0.0, 0.0}; //world position the player shoots towards
         CInput(bool u, bool d, bool l, bool r, bool s, bool sp)
             : up(u), down(d), left(l), right(r), shoot(s), special(sp) {}
         CInput() = default;
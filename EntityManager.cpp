@@ -1,5 +1,7 @@
 #include "EntityManager.h"
+#include "Metrics.h"
 #include <iostream>
+#include <algorithm>
 
 EntityManager::EntityManager() = default;
 
@@ -12,6 +14,9 @@ std::shared_ptr<Entity> EntityManager::addEntity(const std::string& tag)
 
 void EntityManager::update()
 {
+    ScopedTimer timer(Timer::EntityUpdate);
+    Metrics::add(Counter::EntitiesSpawned, m_toAdd.size());
+
     for (auto& entity : m_toAdd)
     {
         m_entities.push_back(entity);
@@ -20,11 +25,13 @@ void EntityManager::update()
     m_toAdd.clear();
     
     // Remove dead entities from m_entities
+    size_t before = m_entities.size();
     m_entities.erase(
         std::remove_if(m_entities.begin(), m_entities.end(), 
             [](const std::shared_ptr<Entity>& entity) { return !entity->isAlive(); }),
         m_entities.end()
     );
+    Metrics::add(Counter::EntitiesDestroyed, before - m_entities.size());
     
     // Remove dead entities from m_entityMap
     for (auto& [tag, entityVec] : m_entityMap)
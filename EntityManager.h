@@ -21,4 +21,5 @@ class EntityManager
         std::shared_ptr<Entity> addEntity(const std::string& tag);
         EntityVec& getEntities();
         EntityVec& getEntities(const std::string& tag);
+        const EntityMap& getEntityMap() const {return m_entityMap;}
 };
\ No newline at end of file
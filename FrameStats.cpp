@@ -0,0 +1,112 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+FrameStats::FrameStats(bool frameTimes) : m_startResident(currentResidentBytes())
+{
+    if(frameTimes)
+    {
+        m_buckets.assign(BUCKETS, 0);
+    }
+}
+
+void FrameStats::record(double seconds, EntityManager& entities)
+{
+    if(!m_buckets.empty())
+    {
+        int bucket = std::min(static_cast<int>(seconds / BUCKET_SECONDS), BUCKETS - 1);
+        m_buckets[bucket]++;
+    }
+    m_frames++;
+    m_totalSeconds += seconds;
+    m_maxSeconds = std::max(m_maxSeconds, seconds);
+
+    m_peakEntities = std::max(m_peakEntities, entities.getEntities().size());
+    for(auto& [tag, entityVec] : entities.getEntityMap())
+    {
+        size_t& peak = m_peakByTag[tag];
+        peak = std::max(peak, entityVec.size());
+    }
+}
+
+double FrameStats::percentile(double p) const
+{
+    if(m_frames == 0 || m_buckets.empty())
+    {
+        return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(m_frames - 1)) + 1;
+    uint64_t seen = 0;
+    for(int i = 0; i < BUCKETS; i++)
+    {
+        seen += m_buckets[i];
+        if(seen >= rank)
+        {
+            return (i + 1) * BUCKET_SECONDS; // upper edge of the bucket
+        }
+    }
+    return m_maxSeconds;
+}
+
+void FrameStats::report(std::ostream& out) const
+{
+    size_t endResident = currentResidentBytes();
+    out << "Frames: " << m_frames << "\n";
+    if(m_frames > 0)
+    {
+        out << "Frame time (ms): mean " << m_totalSeconds / m_frames * 1000.0
+            << " p50 " << percentile(0.50) * 1000.0
+            << " p90 " << percentile(0.90) * 1000.0
+            << " p99 " << percentile(0.99) * 1000.0
+            << " p99.9 " << percentile(0.999) * 1000.0
+            << " max " << m_maxSeconds * 1000.0 << "\n";
+    }
+    out << "Peak entities: " << m_peakEntities << "\n";
+    for(auto& [tag, peak] : m_peakByTag)
+    {
+        out << "  " << tag << ": " << peak << "\n";
+    }
+    out << "Resident memory (KB): start " << m_startResident / 1024
+        << " end " << endResident / 1024
+        << " growth " << (static_cast<long long>(endResident) - static_cast<long long>(m_startResident)) / 1024
+        << " peak " << std::max(peakResidentBytes(), endResident) / 1024 << std::endl; // ru_maxrss is updated lazily and can lag the current size
+}
+
+size_t FrameStats::currentResidentBytes()
+{
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // Second field of statm is the resident set in pages
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    if(!(statm >> pages >> resident))
+    {
+        return 0;
+    }
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+size_t FrameStats::peakResidentBytes()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss); // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#endif
+}
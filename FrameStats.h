@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "EntityManager.h"
+
+// Soak test statistics. Frame times go into a fixed histogram instead of a growing list
+// so that hours-long runs measure the game's memory growth and not their own.
+class FrameStats
+{
+    private:
+        static constexpr double BUCKET_SECONDS = 0.000001; // 1 microsecond resolution, headless frames are short
+        static constexpr int BUCKETS = 100000; // up to 100 ms, slower frames land in the last bucket
+
+        std::vector<uint64_t> m_buckets; // empty unless frame times are kept, batch worlds only need the peaks
+        uint64_t m_frames = 0;
+        double m_totalSeconds = 0.0;
+        double m_maxSeconds = 0.0;
+        size_t m_peakEntities = 0;
+        std::map<std::string, size_t> m_peakByTag;
+        size_t m_startResident = 0;
+
+        double percentile(double p) const;
+    public:
+        explicit FrameStats(bool frameTimes = true);
+        void record(double seconds, EntityManager& entities);
+        void report(std::ostream& out) const;
+        size_t getPeakEntities() const {return m_peakEntities;}
+
+        static size_t currentResidentBytes();
+        static size_t peakResidentBytes();
+};
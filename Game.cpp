@@ -1,55 +1,100 @@
 #include "Game.h"
+#include "Metrics.h"
 #include <fstream>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
-void Game::init(const std::string& configFile)
+std::atomic<bool> Game::s_stopRequested{false};
+
+std::shared_ptr<const GameConfig> Game::loadConfig(const std::string& configFile)
 {
-    srand(static_cast<unsigned int>(time(0)));
+    auto config = std::make_shared<GameConfig>();
     std::ifstream file(configFile);
     if (!file.is_open())
     {
         std::cerr << "Error: Could not open config file: " << configFile << std::endl;
     }
-    std::string line;
-    int frameRate;
-    unsigned int windowWidth;
-    unsigned int windowHeight;
-    bool fullscreen;
-    std::string fontPath;
-    int fontSize;
-    int fontRed;
-    int fontGreen;
-    int fontBlue;
     // Read config values
     std::string label;
-    file >> label >> windowWidth >> windowHeight >> frameRate >> fullscreen;
-    file >> label >> fontPath;
+    file >> label >> config->windowWidth >> config->windowHeight >> config->frameRate >> config->fullscreen;
+    // The World line is optional, without it the arena is the size of the window
+    file >> label;
+    if (label == "World")
+    {
+        file >> config->worldWidth >> config->worldHeight >> label;
+    }
+    else
+    {
+        config->worldWidth = static_cast<float>(config->windowWidth);
+        config->worldHeight = static_cast<float>(config->windowHeight);
+    }
+    file >> config->fontPath;
     // Remove quotes from fontPath if present
-    if (fontPath.front() == '"' && fontPath.back() == '"') {
-        fontPath = fontPath.substr(1, fontPath.length() - 2);
+    if (config->fontPath.size() >= 2 && config->fontPath.front() == '"' && config->fontPath.back() == '"') {
+        config->fontPath = config->fontPath.substr(1, config->fontPath.length() - 2);
     }
-    file >> fontSize >> fontRed >> fontGreen >> fontBlue;
-    file >> label >> m_playerConfig.SR >> m_playerConfig.CR >> m_playerConfig.FR >> m_playerConfig.FG >> m_playerConfig.FB >> m_playerConfig.OR >> m_playerConfig.OG >> m_playerConfig.OB >> m_playerConfig.OT >> m_playerConfig.V >> m_playerConfig.S;
-    file >> label >> m_enemyConfig.SR >> m_enemyConfig.CR >> m_enemyConfig.OR >> m_enemyConfig.OG >> m_enemyConfig.OB >> m_enemyConfig.OT >> m_enemyConfig.VMIN >> m_enemyConfig.VMAX >> m_enemyConfig.L >> m_enemyConfig.SI >> m_enemyConfig.SMIN >> m_enemyConfig.SMAX;
-    file >> label >> m_bulletConfig.SR >> m_bulletConfig.CR >> m_bulletConfig.FR >> m_bulletConfig.FG >> m_bulletConfig.FB >> m_bulletConfig.OR >> m_bulletConfig.OG >> m_bulletConfig.OB >> m_bulletConfig.OT >> m_bulletConfig.V >> m_bulletConfig.L >> m_bulletConfig.S;
-    
-    if(!m_font.openFromFile(fontPath))
+    file >> config->fontSize >> config->fontRed >> config->fontGreen >> config->fontBlue;
+    file >> label >> config->player.SR >> config->player.CR >> config->player.FR >> config->player.FG >> config->player.FB >> config->player.OR >> config->player.OG >> config->player.OB >> config->player.OT >> config->player.V >> config->player.S;
+    file >> label >> config->enemy.SR >> config->enemy.CR >> config->enemy.OR >> config->enemy.OG >> config->enemy.OB >> config->enemy.OT >> config->enemy.VMIN >> config->enemy.VMAX >> config->enemy.L >> config->enemy.SI >> config->enemy.SMIN >> config->enemy.SMAX;
+    file >> label >> config->bullet.SR >> config->bullet.CR >> config->bullet.FR >> config->bullet.FG >> config->bullet.FB >> config->bullet.OR >> config->bullet.OG >> config->bullet.OB >> config->bullet.OT >> config->bullet.V >> config->bullet.L >> config->bullet.S;
+    // A malformed file leaves the rest of the values at zero, which the game cannot run with (spawn interval is a divisor)
+    if (!file || config->enemy.SI <= 0 || config->worldWidth <= 0 || config->worldHeight <= 0)
     {
-        std::cerr << "Error: Could not load font: " << fontPath << std::endl;
+        std::cerr << "Error: Could not parse config file: " << configFile << std::endl;
+        std::exit(1);
+    }
+    return config;
+}
+
+void Game::init()
+{
+    // Headless runs never open a window, so there is nothing to draw text into either
+    if(!m_options.headless)
+    {
+        if(!m_font.openFromFile(m_config->fontPath))
+        {
+            std::cerr << "Error: Could not load font: " << m_config->fontPath << std::endl;
+        }
+        m_Text = std::make_shared<sf::Text>(m_font);
+        m_Text->setFillColor(sf::Color(m_config->fontRed, m_config->fontGreen, m_config->fontBlue));
+
+        m_window = std::make_unique<sf::RenderWindow>(sf::VideoMode({m_config->windowWidth, m_config->windowHeight}), "Geometry Wars");
+        m_window->setFramerateLimit(m_config->frameRate);
+        m_camera = m_window->getDefaultView();
     }
-    m_Text = std::make_shared<sf::Text>(m_font);
-    m_Text->setFillColor(sf::Color(fontRed, fontGreen, fontBlue));
 
-    m_window.create(sf::VideoMode({windowWidth, windowHeight}), "Geometry Wars");
-    m_window.setFramerateLimit(frameRate);
+    m_worldSize = Vec2{m_config->worldWidth, m_config->worldHeight};
+    m_worldBorder.setSize({m_config->worldWidth, m_config->worldHeight});
+    m_worldBorder.setFillColor(sf::Color::Transparent);
+    m_worldBorder.setOutlineColor(sf::Color(80, 80, 80));
+    m_worldBorder.setOutlineThickness(4.0f);
+    m_grid.resize(m_worldSize, 128.0f); // Cells a few times larger than an enemy keep queries to a handful of cells
 
     spawnPlayer();
+    for(int i = 0; i < m_options.enemies; i++)
+    {
+        spawnEnemy();
+    }
+
+    if(m_options.autopilot)
+    {
+        m_controller = std::make_shared<Autopilot>(m_worldSize, m_config->bullet.S);
+    }
 }
 
-Game::Game(const std::string& configFile)
+Game::Game(const std::string& configFile, const GameOptions& options)
+    : m_config(loadConfig(configFile)), m_options(options), m_spawnRandom(options.seed, RandomStream::Spawn), m_frameStats(options.report)
 {
-    init(configFile);
+    init();
+}
+
+Game::Game(std::shared_ptr<const GameConfig> config, const GameOptions& options)
+    : m_config(config), m_options(options), m_spawnRandom(options.seed, RandomStream::Spawn), m_frameStats(options.report)
+{
+    init();
 }
 
 void Game::spawnPlayer()
@@ -59,12 +104,12 @@ void Game::spawnPlayer()
     //Add player entity
     auto entity = m_entities.addEntity("player");
 
-    float centerX = m_window.getSize().x / 2;
-    float centerY = m_window.getSize().y / 2;
+    float centerX = m_worldSize.x / 2;
+    float centerY = m_worldSize.y / 2;
     float speed = 5.0f;
     
     //Add tranform component
-    entity->cTransform = std::make_shared<CTransform>(Vec2{centerX, centerY}, Vec2{m_playerConfig.S,m_playerConfig.S}, sf::degrees(0.0));
+    entity->cTransform = std::make_shared<CTransform>(Vec2{centerX, centerY}, Vec2{m_config->player.S,m_config->player.S}, sf::degrees(0.0));
 
     //Add shape component
     entity->cShape = std::make_shared<CShape>(32.0f, 8, sf::Color(10,10,10), sf::Color(255, 0,0), 4.0f);
@@ -83,72 +128,112 @@ void Game::spawnEnemy()
 {
     auto entity = m_entities.addEntity("enemy");
 
-    float xSpawn = m_enemyConfig.SR + static_cast<float>(rand()) / static_cast<float>(RAND_MAX/(m_window.getSize().x - m_enemyConfig.SR)); //don't need to to multiply by 2 because we setOrigin in CShape
-    float ySpawn = m_enemyConfig.SR + static_cast<float>(rand()) / static_cast<float>(RAND_MAX/(m_window.getSize().y - m_enemyConfig.SR));
+    // One batch draw per enemy: x, y, speed, heading, red, green, blue
+    float r[7];
+    m_spawnRandom.uniform(r, 7, 0.0f, 1.0f);
+
+    // Keep the whole shape inside the world, the origin is at the center of the shape
+    float xSpawn = m_config->enemy.SR + r[0] * (m_worldSize.x - 2 * m_config->enemy.SR);
+    float ySpawn = m_config->enemy.SR + r[1] * (m_worldSize.y - 2 * m_config->enemy.SR);
 
-    float speed = m_enemyConfig.SMIN + static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * (m_enemyConfig.SMAX - m_enemyConfig.SMIN);
+    float speed = m_config->enemy.SMIN + r[2] * (m_config->enemy.SMAX - m_config->enemy.SMIN);
 
     // Generate random direction for velocity
-    float angle = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 2.0f * M_PI;
+    float angle = r[3] * 2.0f * M_PI;
     float velX = speed * cos(angle);
     float velY = speed * sin(angle);
 
     entity->cTransform = std::make_shared<CTransform>(Vec2{xSpawn, ySpawn}, Vec2{velX, velY}, sf::degrees(0.0));
 
-    float randR = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 255;
-    float randG = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 255;
-    float randB = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 255;
+    float randR = r[4] * 255;
+    float randG = r[5] * 255;
+    float randB = r[6] * 255;
 
-    int vertices = m_enemyConfig.VMIN + static_cast<int>(rand()) / static_cast<int>(RAND_MAX/(m_enemyConfig.VMAX - m_enemyConfig.VMIN));
+    int vertices = m_spawnRandom.uniformInt(m_config->enemy.VMIN, m_config->enemy.VMAX);
 
     //Add shape component
-    entity->cShape = std::make_shared<CShape>(m_enemyConfig.SR, vertices, sf::Color(randR, randG, randB), sf::Color(m_enemyConfig.OR, m_enemyConfig.OG, m_enemyConfig.OB), m_enemyConfig.OT);
+    entity->cShape = std::make_shared<CShape>(m_config->enemy.SR, vertices, sf::Color(randR, randG, randB), sf::Color(m_config->enemy.OR, m_config->enemy.OG, m_config->enemy.OB), m_config->enemy.OT);
 
     //Add score component
     entity->cScore = std::make_shared<CScore>(vertices * 100);
 
-    //Add life span component
-    entity->cLifeSpan = std::make_shared<CLifeSpan>(m_enemyConfig.L);
+    //Add life span component. Large enemies never expire so this is not scheduled on the timing wheel
+    entity->cLifeSpan = std::make_shared<CLifeSpan>(m_config->enemy.L, m_currentFrame);
 }
 
-void Game::spawnBullet(std::shared_ptr<Entity> entity, const Vec2& mousePos)
+void Game::spawnBullet(std::shared_ptr<Entity> entity, const Vec2& aim)
 {
     auto bullet = m_entities.addEntity("bullet");
     //Use player position and direction. Bullet will be spawned at player position and will travel in the direction of the vector at given speed
 
-    float speed = m_bulletConfig.S;
+    float speed = m_config->bullet.S;
 
-    Vec2 normalizedDirection = (mousePos - m_player->cTransform->pos).normalized();
+    Vec2 normalizedDirection = (aim - m_player->cTransform->pos).normalized();
 
     bullet->cTransform = std::make_shared<CTransform>(m_player->cTransform->pos, normalizedDirection * speed, sf::degrees(0.0));
 
-    bullet->cShape = std::make_shared<CShape>(m_bulletConfig.SR, m_bulletConfig.V, sf::Color(m_bulletConfig.FR, m_bulletConfig.FG, m_bulletConfig.FB), sf::Color(m_bulletConfig.OR, m_bulletConfig.OG, m_bulletConfig.OB), m_bulletConfig.OT);
+    bullet->cShape = std::make_shared<CShape>(m_config->bullet.SR, m_config->bullet.V, sf::Color(m_config->bullet.FR, m_config->bullet.FG, m_config->bullet.FB), sf::Color(m_config->bullet.OR, m_config->bullet.OG, m_config->bullet.OB), m_config->bullet.OT);
 
-    bullet->cLifeSpan = std::make_shared<CLifeSpan>(m_bulletConfig.L);
+    addLifeSpan(bullet, m_config->bullet.L);
 
 
     
 }
 
 
+void Game::addLifeSpan(std::shared_ptr<Entity> entity, int frames)
+{
+    entity->cLifeSpan = std::make_shared<CLifeSpan>(frames, m_currentFrame);
+    m_lifeSpans.schedule(entity, entity->cLifeSpan->deathFrame);
+}
+
 void Game::sLifeSpan()
 {
-    for(auto entity : m_entities.getEntities())
+    ScopedTimer timer(Timer::SystemLifeSpan);
+    // Only entities whose death frame is now come back from the wheel
+    m_expired.clear();
+    m_lifeSpans.advance(m_currentFrame, m_expired);
+    for(auto& entity : m_expired)
     {
-        if(entity->cLifeSpan && entity->cTransform && entity->getTag() != "enemy")
-        {
-            entity->cLifeSpan->remaining--;
-            if(entity->cLifeSpan->remaining <= 0)
-            {
-                entity->destroy();
-            }
-        }
+        entity->destroy();
+    }
+}
+
+void Game::publishMetrics()
+{
+    Metrics::set(Gauge::Score, m_score);
+    Metrics::set(Gauge::EntitiesPlayer, m_entities.getEntities("player").size());
+    Metrics::set(Gauge::EntitiesEnemy, m_entities.getEntities("enemy").size());
+    Metrics::set(Gauge::EntitiesSmallEnemy, m_entities.getEntities("smallEnemy").size());
+    Metrics::set(Gauge::EntitiesBullet, m_entities.getEntities("bullet").size());
+    Metrics::set(Gauge::EntitiesSpecialBullet, m_entities.getEntities("specialBullet").size());
+}
+
+void Game::updateCamera()
+{
+    sf::Vector2f viewSize = sf::Vector2f(m_window->getSize());
+    float centerX = m_worldSize.x / 2;
+    float centerY = m_worldSize.y / 2;
+    // Follow the player unless the world is smaller than the window along that axis
+    if(m_worldSize.x > viewSize.x)
+    {
+        centerX = std::clamp(m_player->cTransform->pos.x, viewSize.x / 2, m_worldSize.x - viewSize.x / 2);
     }
+    if(m_worldSize.y > viewSize.y)
+    {
+        centerY = std::clamp(m_player->cTransform->pos.y, viewSize.y / 2, m_worldSize.y - viewSize.y / 2);
+    }
+    m_camera.setSize(viewSize);
+    m_camera.setCenter({centerX, centerY});
 }
 
 void Game::sRender()
 {
-    m_window.clear();
+    ScopedTimer timer(Timer::SystemRender);
+    m_window->clear();
+    updateCamera();
+    m_window->setView(m_camera);
+    m_window->draw(m_worldBorder);
     
     // Check if player exists and has required components
     if (m_player && m_player->cShape && m_player->cTransform)
@@ -158,36 +243,45 @@ void Game::sRender()
         m_player->cTransform->angle += sf::degrees(1.0f);
         m_player->cShape->circle.setRotation(m_player->cTransform->angle);
 
-        m_window.draw(m_player->cShape->circle);
+        m_window->draw(m_player->cShape->circle);
     }
 
-    for(auto entity : m_entities.getEntities())
+    // Only entities in cells overlapping the camera are touched, the rest of the world still simulates
+    sf::Vector2f viewCenter = m_camera.getCenter();
+    sf::Vector2f viewHalf = m_camera.getSize() / 2.0f;
+    m_visible.clear();
+    m_grid.query(Vec2{viewCenter.x - viewHalf.x, viewCenter.y - viewHalf.y}, Vec2{viewCenter.x + viewHalf.x, viewCenter.y + viewHalf.y}, m_visible);
+
+    for(auto entity : m_visible)
     {
         if(entity->cShape && entity->cTransform && entity->getTag() != "player")
         {
             entity->cShape->circle.setPosition({entity->cTransform->pos.x, entity->cTransform->pos.y});
             entity->cTransform->angle += sf::degrees(1.0f);
             entity->cShape->circle.setRotation(m_player->cTransform->angle);
-            if(entity->cLifeSpan && entity->cLifeSpan->remaining > 0 && entity->getTag() != "player" && entity->getTag() != "enemy")
+            int64_t remaining = entity->cLifeSpan ? entity->cLifeSpan->deathFrame - m_currentFrame : 0;
+            if(entity->cLifeSpan && remaining > 0 && entity->getTag() != "player" && entity->getTag() != "enemy")
             {
                 sf::Color currentColor = entity->cShape->circle.getFillColor();
                 sf::Color currentOutlineColor = entity->cShape->circle.getOutlineColor();
-                float alphaRatio = static_cast<float>(entity->cLifeSpan->remaining) / static_cast<float>(entity->cLifeSpan->total);
+                float alphaRatio = static_cast<float>(remaining) / static_cast<float>(entity->cLifeSpan->total);
                 unsigned int newAlpha = static_cast<unsigned int>(255 * alphaRatio);
                 sf::Color newColor(currentColor.r, currentColor.g, currentColor.b, newAlpha);
                 sf::Color newOutlineColor(currentOutlineColor.r, currentOutlineColor.g, currentOutlineColor.b, newAlpha);
                 entity->cShape->circle.setFillColor(newColor);
                 entity->cShape->circle.setOutlineColor(newOutlineColor);
             }
-            m_window.draw(entity->cShape->circle);
+            m_window->draw(entity->cShape->circle);
         }
     }
 
+    // Score stays fixed to the screen rather than the world
+    m_window->setView(m_window->getDefaultView());
     m_Text->setString("Score: " + std::to_string(m_score));
     m_Text->setPosition({10, 10});
-    m_window.draw(*m_Text);
+    m_window->draw(*m_Text);
 
-    m_window.display();
+    m_window->display();
 }
 
 
@@ -204,7 +298,7 @@ void Game::spawnSpecialAbility(std::shared_ptr<Entity> entity) //Adds bullets in
             float y = entity->cTransform->pos.y + entity->cShape->circle.getRadius() * sin(angleRad);
             bullet->cTransform = std::make_shared<CTransform>(Vec2{x, y}, Vec2{0, 0}, sf::degrees(0.0));
             bullet->cShape = std::make_shared<CShape>(entity->cShape->circle.getRadius() * 2, entity->cShape->circle.getPointCount(), entity->cShape->circle.getFillColor(), entity->cShape->circle.getOutlineColor(), entity->cShape->circle.getOutlineThickness());
-            bullet->cLifeSpan = std::make_shared<CLifeSpan>(60);
+            addLifeSpan(bullet, 60);
         }
         entity->cSpecialAbility->cooldown = 60;
     }
@@ -212,8 +306,17 @@ void Game::spawnSpecialAbility(std::shared_ptr<Entity> entity) //Adds bullets in
 
 void Game::sUserInput()
 {
+    ScopedTimer timer(Timer::SystemUserInput);
+    if(m_options.headless)
+    {
+        if(m_controller)
+        {
+            m_controller->update(*m_player, m_entities, m_currentFrame);
+        }
+        return;
+    }
 
-    while(auto event = m_window.pollEvent())
+    while(auto event = m_window->pollEvent())
     {
         if(event->is<sf::Event::Closed>())
         {
@@ -311,26 +414,37 @@ void Game::sUserInput()
             }
         }
     }
+
+    if(m_controller)
+    {
+        m_controller->update(*m_player, m_entities, m_currentFrame);
+    }
+    else
+    {
+        sf::Vector2f mousePos = m_window->mapPixelToCoords(sf::Mouse::getPosition(*m_window), m_camera);
+        m_player->cInput->aim = Vec2(mousePos.x, mousePos.y);
+    }
 }
 
 void Game::sMovement()
 {
+    ScopedTimer timer(Timer::SystemMovement);
     m_player->cTransform->vel = Vec2{0.0f, 0.0f};
-    if(m_player->cInput->left && m_player->cTransform->pos.x - m_playerConfig.S - m_playerConfig.SR > 0)
+    if(m_player->cInput->left && m_player->cTransform->pos.x - m_config->player.S - m_config->player.SR > 0)
     {
-        m_player->cTransform->vel.x -= m_playerConfig.S;
+        m_player->cTransform->vel.x -= m_config->player.S;
     }
-    if(m_player->cInput->right && m_player->cTransform->pos.x + m_playerConfig.S + m_playerConfig.SR < m_window.getSize().x)
+    if(m_player->cInput->right && m_player->cTransform->pos.x + m_config->player.S + m_config->player.SR < m_worldSize.x)
     {
-        m_player->cTransform->vel.x += m_playerConfig.S;
+        m_player->cTransform->vel.x += m_config->player.S;
     }
-    if(m_player->cInput->up && m_player->cTransform->pos.y - m_playerConfig.S - m_playerConfig.SR > 0)
+    if(m_player->cInput->up && m_player->cTransform->pos.y - m_config->player.S - m_config->player.SR > 0)
     {
-        m_player->cTransform->vel.y -= m_playerConfig.S;
+        m_player->cTransform->vel.y -= m_config->player.S;
     }
-    if(m_player->cInput->down && m_player->cTransform->pos.y + m_playerConfig.S + m_playerConfig.SR < m_window.getSize().y)
+    if(m_player->cInput->down && m_player->cTransform->pos.y + m_config->player.S + m_config->player.SR < m_worldSize.y)
     {
-        m_player->cTransform->vel.y += m_playerConfig.S;
+        m_player->cTransform->vel.y += m_config->player.S;
     }
     m_player->cTransform->pos += m_player->cTransform->vel;
 
@@ -338,7 +452,7 @@ void Game::sMovement()
     {
         if(entity->cTransform && entity->cShape && (entity->getTag() == "enemy" || entity->getTag() == "smallEnemy"))
         {
-            if(entity->cTransform->pos.x + entity->cTransform->vel.x - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.x + entity->cTransform->vel.x + entity->cShape->circle.getRadius() < m_window.getSize().x && entity->cTransform->pos.y + entity->cTransform->vel.y - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.y + entity->cTransform->vel.y + entity->cShape->circle.getRadius() < m_window.getSize().y)
+            if(entity->cTransform->pos.x + entity->cTransform->vel.x - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.x + entity->cTransform->vel.x + entity->cShape->circle.getRadius() < m_worldSize.x && entity->cTransform->pos.y + entity->cTransform->vel.y - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.y + entity->cTransform->vel.y + entity->cShape->circle.getRadius() < m_worldSize.y)
             {
                 entity->cTransform->pos += entity->cTransform->vel;
             }
@@ -354,104 +468,155 @@ void Game::sMovement()
     {
         if(entity->cTransform && entity->cShape && entity->getTag() == "bullet")
         {
-            if(entity->cTransform->pos.x + entity->cTransform->vel.x - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.x + entity->cTransform->vel.x + entity->cShape->circle.getRadius() < m_window.getSize().x && entity->cTransform->pos.y + entity->cTransform->vel.y - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.y + entity->cTransform->vel.y + entity->cShape->circle.getRadius() < m_window.getSize().y)
+            if(entity->cTransform->pos.x + entity->cTransform->vel.x - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.x + entity->cTransform->vel.x + entity->cShape->circle.getRadius() < m_worldSize.x && entity->cTransform->pos.y + entity->cTransform->vel.y - entity->cShape->circle.getRadius() > 0 && entity->cTransform->pos.y + entity->cTransform->vel.y + entity->cShape->circle.getRadius() < m_worldSize.y)
             entity->cTransform->pos += entity->cTransform->vel;
         }
     }
+
+    m_grid.rebuild(m_entities.getEntities());
 }
 
 void Game::sCollision()
 {
-    for(auto entity : m_entities.getEntities())
+    ScopedTimer timer(Timer::SystemCollision);
+    detectCollisions();
+    resolveCollisions();
+}
+
+void Game::detectContacts(Entity& source, bool bullet)
+{
+    float radius = source.cShape->circle.getRadius();
+    const Vec2& pos = source.cTransform->pos;
+    m_nearby.clear();
+    m_grid.query(Vec2{pos.x - radius, pos.y - radius}, Vec2{pos.x + radius, pos.y + radius}, m_nearby);
+    for(auto target : m_nearby)
     {
-        if(entity->cTransform && entity->cShape && entity->getTag() == "bullet")
+        if(!target->isAlive())
         {
-            for(auto otherEntity : m_entities.getEntities("enemy"))
+            continue;
+        }
+        bool large = target->getTag() == "enemy";
+        if(!large && target->getTag() != "smallEnemy")
+        {
+            continue;
+        }
+        if(!bullet && !large) // small enemies pass through the player
+        {
+            continue;
+        }
+        if(pos.distance(target->cTransform->pos) < radius + target->cShape->circle.getRadius())
+        {
+            ContactKind kind;
+            if(!bullet)
             {
-                float distance = entity->cTransform->pos.distance(otherEntity->cTransform->pos);
-                if(distance < entity->cShape->circle.getRadius() + otherEntity->cShape->circle.getRadius())
-                {
-                    m_score += otherEntity->cScore->score; // Regular enemies give 1 point
-                    spawnSmallEnemies(otherEntity);
-                    entity->destroy();
-                    otherEntity->destroy();
-                }
+                kind = ContactKind::PlayerEnemy;
             }
-            for(auto otherEntity : m_entities.getEntities("smallEnemy"))
+            else if(source.getTag() == "bullet")
             {
-                float distance = entity->cTransform->pos.distance(otherEntity->cTransform->pos);
-                if(distance < entity->cShape->circle.getRadius() + otherEntity->cShape->circle.getRadius())
-                {
-                    m_score += otherEntity->cScore->score; // Small enemies give 2 points
-                    entity->destroy();
-                    otherEntity->destroy();
-                }
+                kind = large ? ContactKind::BulletEnemy : ContactKind::BulletSmallEnemy;
             }
-        }
-        if(entity->cTransform && entity->cShape && entity->getTag() == "player")
-        {
-            for(auto otherEntity : m_entities.getEntities("enemy"))
+            else
             {
-                float distance = entity->cTransform->pos.distance(otherEntity->cTransform->pos);
-                if(distance < entity->cShape->circle.getRadius() + otherEntity->cShape->circle.getRadius())
-                {
-                    m_player->cTransform->pos = Vec2{static_cast<float>(m_window.getSize().x / 2), static_cast<float>(m_window.getSize().y / 2)};
-                    otherEntity->destroy();
-                }
+                kind = large ? ContactKind::SpecialBulletEnemy : ContactKind::SpecialBulletSmallEnemy;
             }
+            m_contacts.push_back(Contact{&source, target, kind});
         }
-        
-        // Handle special bullets - only count as one collision per enemy
-        if(entity->cTransform && entity->cShape && entity->getTag() == "specialBullet")
+    }
+}
+
+void Game::detectCollisions()
+{
+    // Detection only reads the world, every change happens in resolveCollisions
+    m_contacts.clear();
+    for(const char* tag : {"bullet", "specialBullet"})
+    {
+        for(auto& entity : m_entities.getEntities(tag))
         {
-            for(auto otherEntity : m_entities.getEntities("enemy"))
-            {
-                float distance = entity->cTransform->pos.distance(otherEntity->cTransform->pos);
-                if(distance < entity->cShape->circle.getRadius() + otherEntity->cShape->circle.getRadius())
-                {
-                    m_score += 1; // Only 1 point per enemy, not per bullet
-                    spawnSmallEnemies(otherEntity);
-                    otherEntity->destroy();
-                    // Don't destroy the special bullet - let it continue
-                }
-            }
-            for(auto otherEntity : m_entities.getEntities("smallEnemy"))
+            if(entity->isAlive() && entity->cTransform && entity->cShape)
             {
-                float distance = entity->cTransform->pos.distance(otherEntity->cTransform->pos);
-                if(distance < entity->cShape->circle.getRadius() + otherEntity->cShape->circle.getRadius())
-                {
-                    m_score += 2; // Only 2 points per enemy, not per bullet
-                    otherEntity->destroy();
-                    // Don't destroy the special bullet - let it continue
-                }
+                detectContacts(*entity, true);
             }
         }
     }
+    if(m_player->cTransform && m_player->cShape)
+    {
+        detectContacts(*m_player, false);
+    }
+
+    // Group contacts by target so resolveCollisions can apply only the first hit on each enemy.
+    // The stable sort by id keeps detection order within a target and makes the response deterministic
+    std::stable_sort(m_contacts.begin(), m_contacts.end(),
+        [](const Contact& a, const Contact& b) { return a.target->getId() < b.target->getId(); });
+}
+
+void Game::resolveCollisions()
+{
+    const Entity* lastTarget = nullptr;
+    for(auto& contact : m_contacts)
+    {
+        // Touching an enemy always resets the player, even if a bullet got to it first this frame
+        if(contact.kind == ContactKind::PlayerEnemy)
+        {
+            m_player->cTransform->pos = Vec2{m_worldSize.x / 2, m_worldSize.y / 2};
+        }
+
+        // An enemy can only be hit once per frame, otherwise two bullets would split it twice.
+        // Later contacts on the same target have no effect, so their bullets carry on
+        bool firstHit = contact.target != lastTarget;
+        lastTarget = contact.target;
+        if(!firstHit)
+        {
+            continue;
+        }
+
+        switch(contact.kind)
+        {
+            case ContactKind::BulletEnemy:
+                m_score += contact.target->cScore->score;
+                spawnSmallEnemies(*contact.target);
+                contact.source->destroy();
+                break;
+            case ContactKind::BulletSmallEnemy:
+                m_score += contact.target->cScore->score; // Small enemies are worth double
+                contact.source->destroy();
+                break;
+            case ContactKind::PlayerEnemy:
+                break; // The player reset is applied above for every contact
+            case ContactKind::SpecialBulletEnemy:
+                m_score += 1; // Only 1 point per enemy, not per bullet
+                spawnSmallEnemies(*contact.target);
+                break; // Don't destroy the special bullet - let it continue
+            case ContactKind::SpecialBulletSmallEnemy:
+                m_score += 2; // Only 2 points per enemy, not per bullet
+                break;
+        }
+        contact.target->destroy();
+    }
 }
 
-void Game::spawnSmallEnemies(std::shared_ptr<Entity> enemy)
+void Game::spawnSmallEnemies(const Entity& enemy)
 {
-    int numSmallEnemies = enemy->cShape->circle.getPointCount();
+    int numSmallEnemies = enemy.cShape->circle.getPointCount();
     for(int i = 0; i < numSmallEnemies; i++)
     {
         // Convert degrees to radians for cos/sin
         float angleRad = (2.0f * M_PI * i) / numSmallEnemies;
-        float x = enemy->cTransform->pos.x + enemy->cShape->circle.getRadius() * cos(angleRad);
-        float y = enemy->cTransform->pos.y + enemy->cShape->circle.getRadius() * sin(angleRad);
+        float x = enemy.cTransform->pos.x + enemy.cShape->circle.getRadius() * cos(angleRad);
+        float y = enemy.cTransform->pos.y + enemy.cShape->circle.getRadius() * sin(angleRad);
         
         auto smallEnemy = m_entities.addEntity("smallEnemy");
-        smallEnemy->cTransform = std::make_shared<CTransform>(Vec2{x, y}, Vec2{enemy->cTransform->vel.x, enemy->cTransform->vel.y}, sf::degrees(0.0));
-        smallEnemy->cShape = std::make_shared<CShape>(enemy->cShape->circle.getRadius() / 2, enemy->cShape->circle.getPointCount(), enemy->cShape->circle.getFillColor(), enemy->cShape->circle.getOutlineColor(), enemy->cShape->circle.getOutlineThickness());
+        smallEnemy->cTransform = std::make_shared<CTransform>(Vec2{x, y}, Vec2{enemy.cTransform->vel.x, enemy.cTransform->vel.y}, sf::degrees(0.0));
+        smallEnemy->cShape = std::make_shared<CShape>(enemy.cShape->circle.getRadius() / 2, enemy.cShape->circle.getPointCount(), enemy.cShape->circle.getFillColor(), enemy.cShape->circle.getOutlineColor(), enemy.cShape->circle.getOutlineThickness());
         // Give small enemies a lifespan
-        smallEnemy->cScore = std::make_shared<CScore>(enemy->cScore->score * 2);
-        smallEnemy->cLifeSpan = std::make_shared<CLifeSpan>(60); // 60 frames = 1 second at 60 FPS
+        smallEnemy->cScore = std::make_shared<CScore>(enemy.cScore->score * 2);
+        addLifeSpan(smallEnemy, 60); // 60 frames = 1 second at 60 FPS
     }
 }
 
 
 void Game::run()
 {
-    while (m_running)
+    while (m_running && !s_stopRequested.load())
     {
         if(m_paused)
         {
@@ -460,6 +625,7 @@ void Game::run()
         }
         else
         {
+        auto frameStart = std::chrono::steady_clock::now();
 
         m_entities.update();
 
@@ -468,9 +634,12 @@ void Game::run()
         sLifeSpan();
         sCollision();
 
-        sRender();
+        if(!m_options.headless)
+        {
+            sRender();
+        }
 
-        if(m_currentFrame % m_enemyConfig.SI == 0) // 600 frames = 10 seconds later set with config file
+        if(m_currentFrame % m_config->enemy.SI == 0) // 600 frames = 10 seconds later set with config file
         {
             spawnEnemy();
         }
@@ -478,9 +647,7 @@ void Game::run()
         {
             if (m_currentFrame - m_lastBulletSpawnTime > 20) //can only shoot every 20 frames
             {
-                sf::Vector2i mousePos = sf::Mouse::getPosition(m_window);
-                Vec2 mousePosVec = Vec2(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y));
-                spawnBullet(m_player, mousePosVec);
+                spawnBullet(m_player, m_player->cInput->aim);
                 m_lastBulletSpawnTime = m_currentFrame;
             }
         }
@@ -494,9 +661,30 @@ void Game::run()
         {
             m_player->cSpecialAbility->cooldown--;
         }
-        // Small delay to prevent overwhelming the system
-        sf::sleep(sf::milliseconds(16)); // ~60 FPS
+        double frameSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count();
+        m_frameStats.record(frameSeconds, m_entities);
+        Metrics::observe(Timer::Frame, frameSeconds);
+        Metrics::add(Counter::Frames);
+        if(m_options.gauges && Metrics::isEnabled())
+        {
+            publishMetrics();
+        }
+        if(m_options.frames > 0 && m_currentFrame >= m_options.frames)
+        {
+            m_running = false;
+        }
+        // Small delay to prevent overwhelming the system, headless runs go as fast as they can
+        if(!m_options.headless)
+        {
+            sf::sleep(sf::milliseconds(16)); // ~60 FPS
+        }
     }
     
     }
+
+    if(m_options.report && (m_options.headless || m_options.autopilot))
+    {
+        std::cout << "Seed: " << m_options.seed << "\n";
+        m_frameStats.report(std::cout);
+    }
 }
\ No newline at end of file
@@ -1,50 +1,89 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <atomic>
 #include "EntityManager.h"
 #include "Entity.h"
 #include "Vec2.h"
 #include "Components.h"
+#include "TimingWheel.h"
+#include "SpatialGrid.h"
+#include "PlayerController.h"
+#include "FrameStats.h"
+#include "Random.h"
 
 struct PlayerConfig {int SR, CR, FR, FG, FB, OR, OG, OB, OT, V; float S;}; //SR = Shape Radius, CR = Circle Radius, FR = Fill Red, FG = Fill Green, FB = Fill Blue, OR = Outline Red, OG = Outline Green, OB = Outline Blue, OT = Outline Thickness, V = Vertices, S = Speed
 struct EnemyConfig {int SR, CR, OR, OG, OB, OT, VMIN, VMAX, L, SI; float SMIN, SMAX;}; //SR = Shape Radius, CR = Circle Radius, OR = Outline Red, OG = Outline Green, OB = Outline Blue, OT = Outline Thickness, VMIN = Minimum Vertices, VMAX = Maximum Vertices, L = Life Span, SI = Spawn Interval, SMIN = Speed Min, SMAX = Speed Max
 struct BulletConfig {int SR, CR, FR, FG, FB, OR, OG, OB, OT, V, L; float S;}; //SR = Shape Radius, CR = Circle Radius, FR = Fill Red, FG = Fill Green, FB = Fill Blue, OR = Outline Red, OG = Outline Green, OB = Outline Blue, OT = Outline Thickness, V = Vertices, L = Life Span, S = Speed
+struct GameConfig {unsigned int windowWidth, windowHeight; int frameRate; bool fullscreen; float worldWidth, worldHeight; std::string fontPath; int fontSize, fontRed, fontGreen, fontBlue; PlayerConfig player; EnemyConfig enemy; BulletConfig bullet;}; //Everything read from the config file, parsed once and shared read-only between games
+struct GameOptions {uint64_t seed = 0; bool headless = false; bool autopilot = false; bool report = true; bool gauges = true; int64_t frames = 0; int enemies = 0;}; //seed = seeds every random stream of the world, headless = no window or rendering, autopilot = built-in bot drives the player, report = print soak statistics when a headless or autopilot run ends, gauges = publish score and entity counts to the metrics gauges, frames = stop after this many frames (0 = run until closed), enemies = extra enemies spawned at start for load tests
+
+enum class ContactKind {BulletEnemy, BulletSmallEnemy, PlayerEnemy, SpecialBulletEnemy, SpecialBulletSmallEnemy};
+struct Contact {Entity* source; Entity* target; ContactKind kind;}; //source = bullet or player, target = the enemy it touched
 
 class Game
 {
     private:
-        sf::RenderWindow m_window;
+        std::unique_ptr<sf::RenderWindow> m_window; // Only created for windowed runs, constructing one needs a display
+        sf::View m_camera; // Follows the player around the world
+        Vec2 m_worldSize = {0.0f, 0.0f}; // Arena size, can be many screens large
+        sf::RectangleShape m_worldBorder;
+        SpatialGrid m_grid; // Rebuilt after movement, used to cull rendering to what the camera sees
+        std::vector<Entity*> m_visible; // Reused buffer for the render query
+        std::vector<Entity*> m_nearby; // Reused buffer for collision neighbour queries
+        std::vector<Contact> m_contacts; // Collisions found this frame, grouped by target
         EntityManager m_entities; // Might Change to be a pointer to EntityManager
+        TimingWheel m_lifeSpans; // Expiry schedule for every entity with a life span
+        EntityVec m_expired; // Reused buffer for entities the wheel hands back each frame
         sf::Font m_font;
         std::shared_ptr<sf::Text> m_Text;
-        PlayerConfig m_playerConfig;
-        EnemyConfig m_enemyConfig;
-        BulletConfig m_bulletConfig;
-        int m_score = 0;
-        int m_currentFrame = 0;
-        int m_lastEnemySpawnTime = 0;
-        int m_lastBulletSpawnTime = 0;
+        std::shared_ptr<const GameConfig> m_config;
+        GameOptions m_options;
+        Random m_spawnRandom; // Position, speed, heading, color and vertex count of new enemies
+        std::shared_ptr<PlayerController> m_controller; // Drives the player instead of the keyboard when set
+        FrameStats m_frameStats;
+        int64_t m_score = 0; // 64 bit so hours-long headless soak runs cannot overflow
+        int64_t m_currentFrame = 0;
+        int64_t m_lastEnemySpawnTime = 0;
+        int64_t m_lastBulletSpawnTime = 0;
         bool m_paused = false;
         bool m_running = true;
 
         std::shared_ptr<Entity> m_player;
 
-        void init(const std::string& configFile);
+        static std::atomic<bool> s_stopRequested; // Set from a signal handler, ends every running game
+
+        void init();
         void setPaused(bool paused);
 
         void sMovement(); //System: Entity position / movement update Done
         void sUserInput(); //System: Player input Done
         void sLifeSpan(); //System: Entity lifespan update Done
         void sRender(); //System: Entity rendering
+        void publishMetrics(); //Updates the metrics gauges from the current world state
+        void updateCamera(); //Centers the camera on the player, clamped to the world bounds
         void sCollision(); //System: Entity collision update Done
+        void detectCollisions(); //Fills m_contacts without changing the world
+        void detectContacts(Entity& source, bool bullet); //Records contacts between one bullet or the player and nearby enemies
+        void resolveCollisions(); //Applies the first hit on each enemy and every player reset in m_contacts
 
         void spawnPlayer(); //Spawns the player Done
         void spawnEnemy(); //Spawns the enemy Done
-        void spawnSmallEnemies(std::shared_ptr<Entity> enemy);
+        void spawnSmallEnemies(const Entity& enemy);
         void spawnBullet(std::shared_ptr<Entity> entity, const Vec2& direction); 
         void spawnSpecialAbility(std::shared_ptr<Entity> entity);
+        void addLifeSpan(std::shared_ptr<Entity> entity, int frames); //Adds a life span component and schedules its expiry
          
     public:
-        Game(const std::string& configFile);
+        Game(const std::string& configFile, const GameOptions& options = GameOptions());
+        Game(std::shared_ptr<const GameConfig> config, const GameOptions& options = GameOptions());
         void run();
+
+        static std::shared_ptr<const GameConfig> loadConfig(const std::string& configFile);
+        static void requestStop() {s_stopRequested.store(true);} //Safe to call from a signal handler
+        static bool stopRequested() {return s_stopRequested.load();}
+        uint64_t getSeed() const {return m_options.seed;}
+        int64_t getScore() const {return m_score;}
+        int64_t getCurrentFrame() const {return m_currentFrame;}
+        const FrameStats& getFrameStats() const {return m_frameStats;}
 };
\ No newline at end of file
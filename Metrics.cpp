@@ -0,0 +1,212 @@
+#include "Metrics.h"
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+    constexpr int COUNTERS = static_cast<int>(Counter::Count);
+    constexpr int GAUGES = static_cast<int>(Gauge::Count);
+    constexpr int TIMERS = static_cast<int>(Timer::Count);
+
+    // Upper bounds in seconds, a final +Inf bucket is implied
+    constexpr double BUCKET_BOUNDS[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.0167, 0.025, 0.05, 0.1};
+    constexpr int BUCKETS = sizeof(BUCKET_BOUNDS) / sizeof(BUCKET_BOUNDS[0]) + 1;
+
+    struct MetricInfo {const char* name; const char* help; const char* labels;};
+
+    const MetricInfo COUNTER_INFO[COUNTERS] = {
+        {"geometrywars_frames_total", "Simulated frames.", ""},
+        {"geometrywars_entities_spawned_total", "Entities added to the world.", ""},
+        {"geometrywars_entities_destroyed_total", "Entities removed from the world.", ""},
+    };
+    const MetricInfo GAUGE_INFO[GAUGES] = {
+        {"geometrywars_score", "Current score.", ""},
+        {"geometrywars_entities", "Live entities by tag.", "tag=\"player\""},
+        {"geometrywars_entities", "Live entities by tag.", "tag=\"enemy\""},
+        {"geometrywars_entities", "Live entities by tag.", "tag=\"smallEnemy\""},
+        {"geometrywars_entities", "Live entities by tag.", "tag=\"bullet\""},
+        {"geometrywars_entities", "Live entities by tag.", "tag=\"specialBullet\""},
+    };
+    const MetricInfo TIMER_INFO[TIMERS] = {
+        {"geometrywars_frame_seconds", "Time to simulate and render one frame, excluding the frame limiter.", ""},
+        {"geometrywars_entity_update_seconds", "Time spent in EntityManager::update.", ""},
+        {"geometrywars_system_seconds", "Time spent in each system per frame.", "system=\"userInput\""},
+        {"geometrywars_system_seconds", "Time spent in each system per frame.", "system=\"movement\""},
+        {"geometrywars_system_seconds", "Time spent in each system per frame.", "system=\"lifeSpan\""},
+        {"geometrywars_system_seconds", "Time spent in each system per frame.", "system=\"collision\""},
+        {"geometrywars_system_seconds", "Time spent in each system per frame.", "system=\"render\""},
+    };
+
+    // Only the owning thread writes a shard, so a relaxed load and store is enough and no
+    // read-modify-write is needed. Shards are pushed onto a lock-free list the first time a
+    // thread records something and are never freed, so totals survive threads exiting.
+    struct Shard
+    {
+        std::atomic<uint64_t> counters[COUNTERS] = {};
+        std::atomic<uint64_t> buckets[TIMERS][BUCKETS] = {};
+        std::atomic<uint64_t> sumNanoseconds[TIMERS] = {};
+        Shard* next = nullptr;
+    };
+
+    std::atomic<Shard*> s_shards{nullptr};
+    std::atomic<double> s_gauges[GAUGES] = {};
+    thread_local Shard* t_shard = nullptr;
+
+    Shard& localShard()
+    {
+        if(!t_shard)
+        {
+            t_shard = new Shard();
+            t_shard->next = s_shards.load(std::memory_order_relaxed);
+            while(!s_shards.compare_exchange_weak(t_shard->next, t_shard, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+        return *t_shard;
+    }
+
+    void bump(std::atomic<uint64_t>& value, uint64_t amount)
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void writeHeader(std::ostringstream& out, const MetricInfo& info, const char* type, const char*& lastName)
+    {
+        // Labelled series of one metric share a single HELP and TYPE block
+        if(lastName && std::string(lastName) == info.name)
+        {
+            return;
+        }
+        out << "# HELP " << info.name << " " << info.help << "\n";
+        out << "# TYPE " << info.name << " " << type << "\n";
+        lastName = info.name;
+    }
+
+    std::string labels(const MetricInfo& info, const std::string& extra = "")
+    {
+        std::string all = info.labels;
+        if(!extra.empty())
+        {
+            all += all.empty() ? extra : "," + extra;
+        }
+        return all.empty() ? "" : "{" + all + "}";
+    }
+}
+
+std::atomic<bool> Metrics::s_enabled{false};
+
+void Metrics::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Metrics::add(Counter counter, uint64_t amount)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+    bump(localShard().counters[static_cast<int>(counter)], amount);
+}
+
+void Metrics::set(Gauge gauge, double value)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+    s_gauges[static_cast<int>(gauge)].store(value, std::memory_order_relaxed);
+}
+
+void Metrics::observe(Timer timer, double seconds)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+    Shard& shard = localShard();
+    int t = static_cast<int>(timer);
+    int bucket = 0;
+    while(bucket < BUCKETS - 1 && seconds > BUCKET_BOUNDS[bucket])
+    {
+        bucket++;
+    }
+    bump(shard.buckets[t][bucket], 1);
+    bump(shard.sumNanoseconds[t], static_cast<uint64_t>(seconds * 1e9));
+}
+
+std::string Metrics::exposition()
+{
+    uint64_t counters[COUNTERS] = {};
+    uint64_t buckets[TIMERS][BUCKETS] = {};
+    uint64_t sumNanoseconds[TIMERS] = {};
+    for(Shard* shard = s_shards.load(std::memory_order_acquire); shard; shard = shard->next)
+    {
+        for(int c = 0; c < COUNTERS; c++)
+        {
+            counters[c] += shard->counters[c].load(std::memory_order_relaxed);
+        }
+        for(int t = 0; t < TIMERS; t++)
+        {
+            for(int b = 0; b < BUCKETS; b++)
+            {
+                buckets[t][b] += shard->buckets[t][b].load(std::memory_order_relaxed);
+            }
+            sumNanoseconds[t] += shard->sumNanoseconds[t].load(std::memory_order_relaxed);
+        }
+    }
+
+    std::ostringstream out;
+    out << std::setprecision(17); // the default 6 digits would truncate large values like the score
+    const char* lastName = nullptr;
+    for(int c = 0; c < COUNTERS; c++)
+    {
+        writeHeader(out, COUNTER_INFO[c], "counter", lastName);
+        out << COUNTER_INFO[c].name << labels(COUNTER_INFO[c]) << " " << counters[c] << "\n";
+    }
+    for(int g = 0; g < GAUGES; g++)
+    {
+        writeHeader(out, GAUGE_INFO[g], "gauge", lastName);
+        out << GAUGE_INFO[g].name << labels(GAUGE_INFO[g]) << " " << s_gauges[g].load(std::memory_order_relaxed) << "\n";
+    }
+    for(int t = 0; t < TIMERS; t++)
+    {
+        const MetricInfo& info = TIMER_INFO[t];
+        writeHeader(out, info, "histogram", lastName);
+        // Buckets are stored individually, Prometheus expects them cumulative
+        uint64_t cumulative = 0;
+        for(int b = 0; b < BUCKETS; b++)
+        {
+            cumulative += buckets[t][b];
+            std::ostringstream bound;
+            if(b < BUCKETS - 1)
+            {
+                bound << BUCKET_BOUNDS[b];
+            }
+            else
+            {
+                bound << "+Inf";
+            }
+            out << info.name << "_bucket" << labels(info, "le=\"" + bound.str() + "\"") << " " << cumulative << "\n";
+        }
+        out << info.name << "_sum" << labels(info) << " " << sumNanoseconds[t] / 1e9 << "\n";
+        out << info.name << "_count" << labels(info) << " " << cumulative << "\n";
+    }
+    return out.str();
+}
+
+ScopedTimer::ScopedTimer(Timer timer) : m_timer(timer), m_enabled(Metrics::isEnabled())
+{
+    if(m_enabled)
+    {
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if(m_enabled)
+    {
+        Metrics::observe(m_timer, std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum class Counter {Frames, EntitiesSpawned, EntitiesDestroyed, Count};
+enum class Gauge {Score, EntitiesPlayer, EntitiesEnemy, EntitiesSmallEnemy, EntitiesBullet, EntitiesSpecialBullet, Count};
+enum class Timer {Frame, EntityUpdate, SystemUserInput, SystemMovement, SystemLifeSpan, SystemCollision, SystemRender, Count};
+
+// Process-wide metrics. Counters and timer histograms are written into a per-thread shard
+// with relaxed atomics, so recording never takes a lock or contends with another thread;
+// exposition() sums the shards when a scrape comes in. Gauges are a single relaxed store.
+// Everything is a no-op until setEnabled(true), so runs without an exporter pay nothing.
+class Metrics
+{
+    public:
+        static void setEnabled(bool enabled);
+        static bool isEnabled() {return s_enabled.load(std::memory_order_relaxed);}
+
+        static void add(Counter counter, uint64_t amount = 1);
+        static void set(Gauge gauge, double value);
+        static void observe(Timer timer, double seconds);
+
+        static std::string exposition(); // Prometheus text exposition format
+    private:
+        static std::atomic<bool> s_enabled;
+};
+
+// Observes the time between construction and destruction into a timer histogram
+class ScopedTimer
+{
+    private:
+        Timer m_timer;
+        bool m_enabled;
+        std::chrono::steady_clock::time_point m_start;
+    public:
+        ScopedTimer(Timer timer);
+        ~ScopedTimer();
+};
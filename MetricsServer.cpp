@@ -0,0 +1,117 @@
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// macOS has no MSG_NOSIGNAL and uses the SO_NOSIGPIPE socket option instead
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(int port)
+{
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if(m_socket < 0)
+    {
+        std::cerr << "Error: Could not create metrics socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Loopback only, the endpoint is for local scraping and must not be reachable from outside
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(m_socket, 8) < 0)
+    {
+        std::cerr << "Error: Could not listen for metrics on port " << port << ": " << std::strerror(errno) << std::endl;
+        close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    Metrics::setEnabled(true);
+    m_running = true;
+    m_thread = std::thread(&MetricsServer::serve, this);
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if(!m_running.exchange(false))
+    {
+        return;
+    }
+    m_thread.join();
+    close(m_socket);
+    m_socket = -1;
+}
+
+void MetricsServer::serve()
+{
+    while(m_running)
+    {
+        // Wake up regularly so stop() does not have to wait for a connection
+        pollfd listener = {m_socket, POLLIN, 0};
+        if(poll(&listener, 1, 200) <= 0)
+        {
+            continue;
+        }
+        int client = accept(m_socket, nullptr, nullptr);
+        if(client < 0)
+        {
+            continue;
+        }
+        respond(client);
+        close(client);
+    }
+}
+
+void MetricsServer::respond(int client)
+{
+    // A slow or silent client only ever holds up this thread, and not for long
+    timeval timeout = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+    int noSigPipe = 1;
+    setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+    // The request is only read far enough to answer it, every path serves the metrics
+    char request[1024];
+    if(recv(client, request, sizeof(request), 0) <= 0)
+    {
+        return;
+    }
+
+    std::string body = Metrics::exposition();
+    std::string response = "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while(sent < response.size())
+    {
+        ssize_t written = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if(written <= 0)
+        {
+            return;
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+// Serves Metrics::exposition() over HTTP on 127.0.0.1 from a background thread,
+// e.g. `curl http://127.0.0.1:9100/metrics`. The simulation thread never waits on it.
+class MetricsServer
+{
+    private:
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        int m_socket = -1;
+
+        void serve();
+        void respond(int client);
+    public:
+        MetricsServer() = default;
+        ~MetricsServer();
+        bool start(int port);
+        void stop();
+};
@@ -0,0 +1,92 @@
+#include "PlayerController.h"
+
+Autopilot::Autopilot(const Vec2& worldSize, float bulletSpeed) : m_worldSize(worldSize), m_bulletSpeed(bulletSpeed)
+{
+}
+
+Entity* Autopilot::findNearestEnemy(const Vec2& pos, EntityManager& entities) const
+{
+    Entity* nearest = nullptr;
+    float nearestDistance = 0.0f;
+    for(const char* tag : {"enemy", "smallEnemy"})
+    {
+        for(auto& enemy : entities.getEntities(tag))
+        {
+            if(!enemy->isAlive() || !enemy->cTransform)
+            {
+                continue;
+            }
+            float distance = pos.distance(enemy->cTransform->pos);
+            if(!nearest || distance < nearestDistance)
+            {
+                nearest = enemy.get();
+                nearestDistance = distance;
+            }
+        }
+    }
+    return nearest;
+}
+
+void Autopilot::update(Entity& player, EntityManager& entities, int64_t currentFrame)
+{
+    if(!player.cInput || !player.cTransform)
+    {
+        return;
+    }
+    CInput& input = *player.cInput;
+    const Vec2& pos = player.cTransform->pos;
+
+    // Switch strafing direction every couple of seconds so the bot does not orbit into a corner
+    float strafeDirection = (currentFrame / m_strafePeriod) % 2 == 0 ? 1.0f : -1.0f;
+
+    Vec2 move = Vec2{m_worldSize.x / 2, m_worldSize.y / 2} - pos;
+    Entity* target = findNearestEnemy(pos, entities);
+    if(target)
+    {
+        Vec2 toTarget = target->cTransform->pos - pos;
+        float distance = toTarget.length();
+        if(distance > 0.0f)
+        {
+            // Lead the shot by the time the bullet needs to get there
+            input.aim = target->cTransform->pos + target->cTransform->vel * (distance / m_bulletSpeed);
+
+            Vec2 radial = toTarget / distance;
+            Vec2 tangent = Vec2{-radial.y, radial.x} * strafeDirection;
+            float approach = distance > m_preferredDistance ? 1.0f : -1.0f;
+            move = radial * approach + tangent;
+        }
+    }
+    else
+    {
+        input.aim = pos + Vec2{1.0f, 0.0f}; // keep firing in a fixed direction while the arena is empty
+    }
+
+    // Steer away from walls, the movement system would otherwise pin the player against them
+    if(pos.x < m_wallMargin)
+    {
+        move.x = 1.0f;
+    }
+    if(pos.x > m_worldSize.x - m_wallMargin)
+    {
+        move.x = -1.0f;
+    }
+    if(pos.y < m_wallMargin)
+    {
+        move.y = 1.0f;
+    }
+    if(pos.y > m_worldSize.y - m_wallMargin)
+    {
+        move.y = -1.0f;
+    }
+
+    // Inputs are digital, so only commit to an axis when it is a meaningful part of the move
+    float length = move.length();
+    Vec2 direction = length > 0.0f ? move / length : Vec2{0.0f, 0.0f};
+    input.left = direction.x < -0.3f;
+    input.right = direction.x > 0.3f;
+    input.up = direction.y < -0.3f;
+    input.down = direction.y > 0.3f;
+
+    input.shoot = true;
+    input.special = player.cSpecialAbility && player.cSpecialAbility->cooldown == 0;
+}
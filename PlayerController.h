@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Entity.h"
+#include "EntityManager.h"
+#include "Vec2.h"
+
+// Drives the player in place of the keyboard and mouse. update() runs once per frame
+// after user input and writes the player's CInput, including the aim point in world space.
+class PlayerController
+{
+    public:
+        virtual ~PlayerController() = default;
+        virtual void update(Entity& player, EntityManager& entities, int64_t currentFrame) = 0;
+};
+
+// Built-in bot for soak and load tests: targets the nearest enemy, strafes around it,
+// shoots continuously and fires the special ability whenever it is off cooldown.
+class Autopilot : public PlayerController
+{
+    private:
+        Vec2 m_worldSize;
+        float m_bulletSpeed;
+        float m_preferredDistance = 250.0f; // keeps enough distance to dodge while staying in range
+        float m_wallMargin = 100.0f; // how close to a wall before steering back towards the middle
+        int m_strafePeriod = 120; // frames between switching strafing direction
+
+        Entity* findNearestEnemy(const Vec2& pos, EntityManager& entities) const;
+    public:
+        Autopilot(const Vec2& worldSize, float bulletSpeed);
+        void update(Entity& player, EntityManager& entities, int64_t currentFrame) override;
+};
@@ -0,0 +1,56 @@
+#include "Random.h"
+
+namespace
+{
+    // Top 24 bits give every float in [0, 1) the same spacing
+    float toUnit(uint64_t x)
+    {
+        return static_cast<float>(x >> 40) * (1.0f / 16777216.0f);
+    }
+
+    // Multiply-shift maps 32 random bits onto [0, range) without a division
+    uint32_t toRange(uint64_t x, uint64_t range)
+    {
+        return static_cast<uint32_t>(((x >> 32) * range) >> 32);
+    }
+}
+
+Random::Random(uint64_t seed, RandomStream stream) : m_key(mix(seed ^ mix(static_cast<uint64_t>(stream) + 1)))
+{
+}
+
+float Random::uniform(float min, float max)
+{
+    return min + toUnit(next()) * (max - min);
+}
+
+int Random::uniformInt(int min, int max)
+{
+    if(max <= min)
+    {
+        return min;
+    }
+    return min + static_cast<int>(toRange(next(), static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1));
+}
+
+void Random::uniform(float* out, size_t count, float min, float max)
+{
+    uint64_t base = m_counter;
+    float scale = max - min;
+    for(size_t i = 0; i < count; i++)
+    {
+        out[i] = min + toUnit(mix(m_key + GAMMA * (base + i + 1))) * scale;
+    }
+    m_counter += count;
+}
+
+void Random::uniformInt(int* out, size_t count, int min, int max)
+{
+    uint64_t base = m_counter;
+    uint64_t range = max <= min ? 1 : static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+    for(size_t i = 0; i < count; i++)
+    {
+        out[i] = min + static_cast<int>(toRange(mix(m_key + GAMMA * (base + i + 1)), range));
+    }
+    m_counter += count;
+}
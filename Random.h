@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+enum class RandomStream : uint64_t {Spawn}; //One independent stream per system that needs randomness
+
+// Counter-based generator (SplitMix64 over a per-stream key). The n-th value of a stream is a
+// pure function of (seed, stream, n), so a world's results do not depend on which thread runs
+// it, and the batch calls have no dependency between elements, which lets them vectorise.
+class Random
+{
+    private:
+        static constexpr uint64_t GAMMA = 0x9e3779b97f4a7c15ULL;
+        uint64_t m_key;
+        uint64_t m_counter = 0;
+
+        static uint64_t mix(uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+    public:
+        Random(uint64_t seed, RandomStream stream);
+        uint64_t next() {return mix(m_key + GAMMA * ++m_counter);}
+        float uniform(float min, float max); // [min, max)
+        int uniformInt(int min, int max); // [min, max], returns min when max <= min
+        void uniform(float* out, size_t count, float min, float max);
+        void uniformInt(int* out, size_t count, int min, int max);
+};
@@ -0,0 +1,74 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+void SpatialGrid::resize(const Vec2& worldSize, float cellSize)
+{
+    m_cellSize = cellSize;
+    m_columns = std::max(1, static_cast<int>(std::ceil(worldSize.x / cellSize)));
+    m_rows = std::max(1, static_cast<int>(std::ceil(worldSize.y / cellSize)));
+    m_cellStart.assign(m_columns * m_rows + 1, 0);
+    m_cellEntities.clear();
+}
+
+int SpatialGrid::cellX(float x) const
+{
+    return std::clamp(static_cast<int>(x / m_cellSize), 0, m_columns - 1);
+}
+
+int SpatialGrid::cellY(float y) const
+{
+    return std::clamp(static_cast<int>(y / m_cellSize), 0, m_rows - 1);
+}
+
+void SpatialGrid::rebuild(const std::vector<std::shared_ptr<Entity>>& entities)
+{
+    std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+    m_entityCell.resize(entities.size());
+    m_maxRadius = 0.0f;
+
+    // Count entities per cell, entities outside the world are clamped onto the border cells
+    for(size_t i = 0; i < entities.size(); i++)
+    {
+        const auto& entity = entities[i];
+        if(!entity->cTransform || !entity->cShape)
+        {
+            m_entityCell[i] = -1;
+            continue;
+        }
+        int cell = cellY(entity->cTransform->pos.y) * m_columns + cellX(entity->cTransform->pos.x);
+        m_entityCell[i] = cell;
+        m_cellStart[cell + 1]++;
+        m_maxRadius = std::max(m_maxRadius, entity->cShape->circle.getRadius() + entity->cShape->circle.getOutlineThickness());
+    }
+
+    for(size_t c = 1; c < m_cellStart.size(); c++)
+    {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+
+    m_cellEntities.resize(m_cellStart.back());
+    m_cursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+    for(size_t i = 0; i < entities.size(); i++)
+    {
+        if(m_entityCell[i] >= 0)
+        {
+            m_cellEntities[m_cursor[m_entityCell[i]]++] = entities[i].get();
+        }
+    }
+}
+
+void SpatialGrid::query(const Vec2& min, const Vec2& max, std::vector<Entity*>& out) const
+{
+    // Entities are bucketed by center, so pad by the largest radius to catch shapes overlapping the edge
+    int x0 = cellX(min.x - m_maxRadius);
+    int x1 = cellX(max.x + m_maxRadius);
+    int y0 = cellY(min.y - m_maxRadius);
+    int y1 = cellY(max.y + m_maxRadius);
+    for(int y = y0; y <= y1; y++)
+    {
+        int rowStart = y * m_columns;
+        // Cells in a row are contiguous, so the whole row span is one range of m_cellEntities
+        out.insert(out.end(), m_cellEntities.begin() + m_cellStart[rowStart + x0], m_cellEntities.begin() + m_cellStart[rowStart + x1 + 1]);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "Entity.h"
+#include "Vec2.h"
+
+// Uniform grid over the world, bucketed by entity center. It is rebuilt once per frame
+// into flat arrays (counting sort) so a rectangle query only touches the cells it overlaps.
+// Stored pointers are only valid until the next EntityManager::update().
+class SpatialGrid
+{
+    private:
+        float m_cellSize = 128.0f;
+        int m_columns = 1;
+        int m_rows = 1;
+        float m_maxRadius = 0.0f; // largest shape inserted since the last rebuild, used to pad queries
+        std::vector<int> m_cellStart; // m_cellStart[c]..m_cellStart[c + 1] indexes m_cellEntities
+        std::vector<Entity*> m_cellEntities;
+        std::vector<int> m_entityCell; // scratch: cell of each entity during rebuild
+        std::vector<int> m_cursor; // scratch: next free index per cell during rebuild
+
+        int cellX(float x) const;
+        int cellY(float y) const;
+    public:
+        SpatialGrid() = default;
+        void resize(const Vec2& worldSize, float cellSize);
+        void rebuild(const std::vector<std::shared_ptr<Entity>>& entities);
+        void query(const Vec2& min, const Vec2& max, std::vector<Entity*>& out) const;
+};
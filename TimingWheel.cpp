@@ -0,0 +1,59 @@
+#include "TimingWheel.h"
+
+void TimingWheel::schedule(const std::shared_ptr<Entity>& entity, int64_t deathFrame)
+{
+    // Anything already due fires on the next advance instead of being lost in a past slot
+    if(deathFrame <= m_currentFrame)
+    {
+        deathFrame = m_currentFrame + 1;
+    }
+    insert(Entry{entity, deathFrame});
+}
+
+void TimingWheel::insert(Entry&& entry)
+{
+    // The level is picked by the highest bit where the death frame differs from the current frame,
+    // so the entry gets cascaded down exactly when the wheel reaches its block of frames
+    uint64_t diff = static_cast<uint64_t>(entry.deathFrame ^ m_currentFrame);
+    int level = 0;
+    while(level < LEVELS - 1 && (diff >> (SLOT_BITS * (level + 1))) != 0)
+    {
+        level++;
+    }
+    int slot = static_cast<int>((entry.deathFrame >> (SLOT_BITS * level)) & (SLOTS - 1));
+    m_slots[level][slot].push_back(std::move(entry));
+}
+
+void TimingWheel::advance(int64_t frame, std::vector<std::shared_ptr<Entity>>& expired)
+{
+    while(m_currentFrame < frame)
+    {
+        m_currentFrame++;
+
+        // Cascade higher levels first whenever the frame crosses their block boundary
+        for(int level = LEVELS - 1; level > 0; level--)
+        {
+            if((m_currentFrame & ((int64_t(1) << (SLOT_BITS * level)) - 1)) != 0)
+            {
+                continue;
+            }
+            int slot = static_cast<int>((m_currentFrame >> (SLOT_BITS * level)) & (SLOTS - 1));
+            m_cascade.clear();
+            m_cascade.swap(m_slots[level][slot]);
+            for(auto& entry : m_cascade)
+            {
+                insert(std::move(entry));
+            }
+        }
+
+        auto& due = m_slots[0][m_currentFrame & (SLOTS - 1)];
+        for(auto& entry : due)
+        {
+            if(auto entity = entry.entity.lock())
+            {
+                expired.push_back(entity);
+            }
+        }
+        due.clear();
+    }
+}
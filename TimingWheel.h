@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Entity.h"
+
+// Hierarchical timing wheel keyed by absolute frame number. Entities are scheduled
+// once with the frame they should die on and advance() only touches the slot for the
+// current frame, so lifespan expiry costs nothing for entities that are not expiring.
+class TimingWheel
+{
+    private:
+        static constexpr int SLOT_BITS = 6;
+        static constexpr int SLOTS = 1 << SLOT_BITS; // 64 slots per level
+        static constexpr int LEVELS = 4; // 64^4 frames, roughly 77 hours at 60 FPS
+
+        struct Entry
+        {
+            std::weak_ptr<Entity> entity;
+            int64_t deathFrame;
+        };
+
+        std::vector<Entry> m_slots[LEVELS][SLOTS];
+        std::vector<Entry> m_cascade; // scratch buffer reused when moving entries down a level
+        int64_t m_currentFrame = 0; // last frame advance() has processed
+
+        void insert(Entry&& entry);
+    public:
+        TimingWheel() = default;
+        void schedule(const std::shared_ptr<Entity>& entity, int64_t deathFrame);
+        void advance(int64_t frame, std::vector<std::shared_ptr<Entity>>& expired);
+};
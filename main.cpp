@@ -1,13 +1,110 @@
 #include <iostream>
+#include <string>
+#include <stdexcept>
 #include "Vec2.h"
 #include "Game.h"
+#include "MetricsServer.h"
+#include "BatchRunner.h"
+#include <ctime>
+#include <csignal>
+#include <thread>
 
-int main()
+// Lets Ctrl-C or a kill end a soak run normally so its report still gets printed
+void handleStopSignal(int)
 {
+    Game::requestStop();
+}
 
-    Game geometryWars("config.txt");
+int main(int argc, char* argv[])
+{
+    const char* usage = "Usage: GeometryWars [--headless] [--autopilot] [--frames N] [--enemies N] [--metrics-port PORT] [--batch WORLDS] [--threads N] [--seed N]";
+    GameOptions options;
+    int metricsPort = 0;
+    bool seedGiven = false;
+    int batchWorlds = 0;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        // Numeric values go through std::sto*, which throw on anything that is not a number
+        try
+        {
+            if(arg == "--headless")
+            {
+                options.headless = true;
+            }
+            else if(arg == "--autopilot")
+            {
+                options.autopilot = true;
+            }
+            else if(arg == "--frames" && i + 1 < argc)
+            {
+                options.frames = std::stoll(argv[++i]);
+            }
+            else if(arg == "--enemies" && i + 1 < argc)
+            {
+                options.enemies = std::stoi(argv[++i]);
+            }
+            else if(arg == "--metrics-port" && i + 1 < argc)
+            {
+                metricsPort = std::stoi(argv[++i]);
+            }
+            else if(arg == "--seed" && i + 1 < argc)
+            {
+                options.seed = std::stoull(argv[++i]);
+                seedGiven = true;
+            }
+            else if(arg == "--batch" && i + 1 < argc)
+            {
+                batchWorlds = std::stoi(argv[++i]);
+            }
+            else if(arg == "--threads" && i + 1 < argc)
+            {
+                threads = std::stoi(argv[++i]);
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n" << usage << std::endl;
+                return 1;
+            }
+        }
+        catch(const std::exception&)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << argv[i] << "\n" << usage << std::endl;
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    MetricsServer metricsServer;
+    if(metricsPort > 0 && !metricsServer.start(metricsPort))
+    {
+        return 1;
+    }
+
+    // Without --seed every run is different, the seed is printed with the report so it can be replayed
+    if(!seedGiven)
+    {
+        options.seed = static_cast<uint64_t>(time(0));
+    }
+
+    if(batchWorlds > 0)
+    {
+        if(options.frames <= 0)
+        {
+            options.frames = 3600; // batch matches have to end on their own, default to a minute at 60 FPS
+        }
+        BatchRunner runner(Game::loadConfig("config.txt"), options, batchWorlds, threads);
+        runner.run();
+        runner.report(std::cout);
+        return 0;
+    }
+
+    Game geometryWars("config.txt", options);
     geometryWars.run();
 
   
     return 0;
-}
\ No newline at end of file
+}